@@ -0,0 +1,156 @@
+#pragma once
+
+#include "shared.h"
+
+#include <cstddef>
+#include <iterator>
+
+// Batch operations over ranges of `SharedPtr`-s.
+// Consecutive references to the same controll block are counted in registers and applied as one
+// aggregated counter update per run. Grouping is deliberately limited to runs: with plain
+// `size_t` counters a per-element table lookup costs more than the increment it saves (see
+// bench/batch_bench.cpp), so interleaved ranges get about one update per element.
+// Objects whose last references were dropped are destructed after the whole batch, or after
+// every 64 of them in bigger batches. Nothing is allocated, so a batch can't fail halfway.
+class SharedBatch {
+public:
+    // Assigns copies of [first, last) to the range starting at `out`, like std::copy
+    template <class ForwardIt, class OutputIt>
+    static OutputIt Copy(ForwardIt first, ForwardIt last, OutputIt out) {
+        Updates updates;
+        Run acquired;
+        Run released;
+        for (; first != last; ++first, ++out) {
+            ControllBlock* block = first->controll_;
+            updates.Acquire(acquired, block);
+            updates.Release(released, acquired, out->controll_);
+            out->ptr_ = first->ptr_;
+            out->controll_ = block;
+        }
+        updates.Finish(acquired, released);
+        return out;
+    }
+
+    // Assigns `value` to every element of [first, last), like std::fill
+    template <class ForwardIt, class T>
+    static void Fill(ForwardIt first, ForwardIt last, const SharedPtr<T>& value) {
+        T* ptr = value.ptr_;
+        ControllBlock* block = value.controll_;
+        Updates updates;
+        Run acquired;
+        Run released;
+        for (; first != last; ++first) {
+            updates.Acquire(acquired, block);
+            updates.Release(released, acquired, first->controll_);
+            first->ptr_ = ptr;
+            first->controll_ = block;
+        }
+        updates.Finish(acquired, released);
+    }
+
+    // Assigns `value` to `count` elements starting at `out`, like std::fill_n
+    template <class ForwardIt, class T>
+    static ForwardIt FillN(ForwardIt out, std::size_t count, const SharedPtr<T>& value) {
+        ForwardIt last = std::next(out, count);
+        Fill(out, last, value);
+        return last;
+    }
+
+    // Drops every pointer of [first, last). Elements are left empty, like moved-from pointers,
+    // so they can only be destroyed or assigned to afterwards.
+    template <class ForwardIt>
+    static void Reset(ForwardIt first, ForwardIt last) {
+        Updates updates;
+        Run acquired;
+        Run released;
+        for (; first != last; ++first) {
+            updates.Release(released, acquired, first->controll_);
+            first->ptr_ = nullptr;
+            first->controll_ = nullptr;
+        }
+        updates.Finish(acquired, released);
+    }
+
+private:
+    // Consecutive references to one block, kept by value in the loops so it stays in registers
+    struct Run {
+        ControllBlock* block = nullptr;
+        std::size_t count = 0;
+    };
+
+    // Applies finished runs and keeps blocks that lost their last references until the end
+    class Updates {
+    public:
+        void Acquire(Run& run, ControllBlock* block) {
+            if (block != run.block) {
+                FlushAcquired(run);
+                run.block = block;
+            }
+            ++run.count;
+        }
+
+        void Release(Run& run, Run& acquired, ControllBlock* block) {
+            if (block != run.block) {
+                FlushReleased(run, acquired);
+                run.block = block;
+            }
+            ++run.count;
+        }
+
+        void Finish(Run& acquired, Run& released) {
+            FlushReleased(released, acquired);
+            FlushAcquired(acquired);
+            DestroyDying();
+        }
+
+    private:
+        static constexpr std::size_t kMaxDying = 64;
+
+        static void FlushAcquired(Run& run) {
+            if (run.block) {
+                run.block->IncreaseStrong(run.count);
+            }
+            run.count = 0;
+        }
+
+        void FlushReleased(Run& run, Run& acquired) {
+            ControllBlock* block = run.block;
+            std::size_t count = run.count;
+            run.count = 0;
+            if (!block) {
+                return;
+            }
+            if (block == acquired.block) {  // so a block being copied can't look dying
+                FlushAcquired(acquired);
+            }
+            if (block->strong > count) {
+                block->DecreaseStrong(count);
+                return;
+            }
+            // Keep the last reference until the batch is finished
+            if (count > 1) {
+                block->DecreaseStrong(count - 1);
+            }
+            if (dying_count_ == kMaxDying) {
+                FlushAcquired(acquired);
+                DestroyDying();
+            }
+            dying_[dying_count_++] = block;
+        }
+
+        void DestroyDying() {
+            // Nobody outside of the batch referenced these objects, so running their destructors
+            // can't drop strong references to other dying blocks
+            for (std::size_t i = 0; i < dying_count_; ++i) {
+                if (dying_[i]->DecreaseStrong()) {
+                    DestroyControllBlock(dying_[i]);
+                }
+            }
+            dying_count_ = 0;
+        }
+
+    private:
+        ControllBlock* dying_[kMaxDying];
+        std::size_t dying_count_ = 0;
+    };
+};
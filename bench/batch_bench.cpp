@@ -0,0 +1,112 @@
+// Per-element loops vs SharedBatch over 1M pointers spread over 8 controll blocks,
+// best of 10 rounds
+#include "batch.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t kSize = 1 << 20;
+constexpr int kRounds = 10;
+constexpr std::size_t kBlocks = 8;
+
+// Best round, in milliseconds
+template <class F>
+double Measure(F&& body) {
+    double best = 0;
+    for (int round = 0; round < kRounds; ++round) {
+        auto start = std::chrono::steady_clock::now();
+        body();
+        std::chrono::duration<double, std::milli> elapsed =
+            std::chrono::steady_clock::now() - start;
+        if (round == 0 || elapsed.count() < best) {
+            best = elapsed.count();
+        }
+    }
+    return best;
+}
+
+void Report(const char* name, double loop, double batch) {
+    std::printf("%-36s loop %8.1f ms   batch %8.1f ms\n", name, loop, batch);
+}
+
+// `run` consecutive pointers share a block, blocks go round-robin starting from `shift`
+std::vector<SharedPtr<int>> MakeSource(const std::vector<SharedPtr<int>>& blocks, std::size_t run,
+                                       std::size_t shift) {
+    std::vector<SharedPtr<int>> source(kSize);
+    for (std::size_t i = 0; i < kSize; ++i) {
+        source[i] = blocks[(i / run + shift) % blocks.size()];
+    }
+    return source;
+}
+
+// Overwrite every pointer of a vector, alternating between two sources
+void Overwrite(const char* name, const std::vector<SharedPtr<int>>& blocks, std::size_t run) {
+    std::vector<SharedPtr<int>> sources[] = {MakeSource(blocks, run, 0),
+                                             MakeSource(blocks, run, 1)};
+    std::vector<SharedPtr<int>> target = sources[1];
+    double loop = Measure([&] {
+        for (const auto& source : sources) {
+            for (std::size_t i = 0; i < kSize; ++i) {
+                target[i] = source[i];
+            }
+        }
+    });
+    double batch = Measure([&] {
+        for (const auto& source : sources) {
+            SharedBatch::Copy(source.begin(), source.end(), target.begin());
+        }
+    });
+    Report(name, loop, batch);
+}
+
+// Fan one value out to a whole vector
+void Fill(const std::vector<SharedPtr<int>>& blocks) {
+    std::vector<SharedPtr<int>> target(kSize, blocks[1]);
+    double loop = Measure([&] {
+        for (const auto& value : {blocks[0], blocks[1]}) {
+            for (auto& ptr : target) {
+                ptr = value;
+            }
+        }
+    });
+    double batch = Measure([&] {
+        for (const auto& value : {blocks[0], blocks[1]}) {
+            SharedBatch::Fill(target.begin(), target.end(), value);
+        }
+    });
+    Report("fill with one value", loop, batch);
+}
+
+// Clear a vector of copies; building the copies is included in both timings
+void Clear(const char* name, const std::vector<SharedPtr<int>>& blocks, std::size_t run) {
+    std::vector<SharedPtr<int>> source = MakeSource(blocks, run, 0);
+    double loop = Measure([&] {
+        std::vector<SharedPtr<int>> target = source;
+        target.clear();
+    });
+    double batch = Measure([&] {
+        std::vector<SharedPtr<int>> target = source;
+        SharedBatch::Reset(target.begin(), target.end());
+        target.clear();
+    });
+    Report(name, loop, batch);
+}
+
+}  // namespace
+
+int main() {
+    std::vector<SharedPtr<int>> blocks;
+    for (std::size_t i = 0; i < kBlocks; ++i) {
+        blocks.push_back(MakeShared<int>(static_cast<int>(i)));
+    }
+
+    Fill(blocks);
+    Overwrite("overwrite, runs of 1024", blocks, 1024);
+    Overwrite("overwrite, interleaved", blocks, 1);
+    Clear("copy + clear, runs of 1024", blocks, 1024);
+    Clear("copy + clear, interleaved", blocks, 1);
+}
@@ -0,0 +1,76 @@
+// CowPtr vs deep copies of an attribute map: every step copies the value,
+// one step in 100 modifies its copy. Best of 10 rounds.
+#include "cow.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Attributes = std::map<std::string, std::string>;
+
+constexpr std::size_t kSteps = 100000;
+constexpr std::size_t kMutateEvery = 100;
+constexpr std::size_t kAttributes = 32;
+constexpr int kRounds = 10;
+
+template <class F>
+double Measure(F&& body) {
+    double best = 0;
+    for (int round = 0; round < kRounds; ++round) {
+        auto start = std::chrono::steady_clock::now();
+        body();
+        std::chrono::duration<double, std::milli> elapsed =
+            std::chrono::steady_clock::now() - start;
+        if (round == 0 || elapsed.count() < best) {
+            best = elapsed.count();
+        }
+    }
+    return best;
+}
+
+Attributes MakeAttributes() {
+    Attributes attributes;
+    for (std::size_t i = 0; i < kAttributes; ++i) {
+        attributes["attribute-" + std::to_string(i)] = "value-" + std::to_string(i);
+    }
+    return attributes;
+}
+
+}  // namespace
+
+int main() {
+    const Attributes original = MakeAttributes();
+    std::size_t checksum = 0;
+
+    double deep = Measure([&] {
+        std::vector<Attributes> copies;
+        copies.reserve(kSteps);
+        for (std::size_t i = 0; i < kSteps; ++i) {
+            copies.push_back(original);
+            if (i % kMutateEvery == 0) {
+                copies.back()["attribute-0"] = "changed";
+            }
+        }
+        checksum += copies.back().size();
+    });
+
+    const CowPtr<Attributes> shared = MakeCow<Attributes>(original);
+    double cow = Measure([&] {
+        std::vector<CowPtr<Attributes>> copies;
+        copies.reserve(kSteps);
+        for (std::size_t i = 0; i < kSteps; ++i) {
+            copies.push_back(shared);
+            if (i % kMutateEvery == 0) {
+                copies.back().Mutable()["attribute-0"] = "changed";
+            }
+        }
+        checksum += copies.back()->size();
+    });
+
+    std::printf("deep copies %8.1f ms   CowPtr %8.1f ms   (checksum %zu)\n", deep, cow, checksum);
+}
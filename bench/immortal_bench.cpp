@@ -0,0 +1,90 @@
+// Copying and destroying a SharedPtr to an immortal object from several threads at once vs
+// the same number of copies of an ordinary MakeShared pointer on one thread (ordinary counters
+// are not atomic, so they can't be shared between threads). Best of 10 rounds.
+#include "immortal.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t kCopies = 1 << 24;
+constexpr int kRounds = 10;
+
+struct Config {
+    constexpr explicit Config(int value = 0) : value(value) {
+    }
+
+    int value;
+};
+
+StaticShared<Config> default_config(1);
+
+template <class F>
+double Measure(F&& body) {
+    double best = 0;
+    for (int round = 0; round < kRounds; ++round) {
+        auto start = std::chrono::steady_clock::now();
+        body();
+        std::chrono::duration<double, std::milli> elapsed =
+            std::chrono::steady_clock::now() - start;
+        if (round == 0 || elapsed.count() < best) {
+            best = elapsed.count();
+        }
+    }
+    return best;
+}
+
+// Copies `ptr` `count` times, every copy is destroyed right away
+long CopyMany(const SharedPtr<Config>& ptr, std::size_t count) {
+    long sum = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        SharedPtr<Config> copy = ptr;
+        sum += copy->value;
+    }
+    return sum;
+}
+
+double CopyOnThreads(const SharedPtr<Config>& ptr, std::size_t threads, long& checksum) {
+    std::vector<long> sums(threads);
+    double elapsed = Measure([&] {
+        std::vector<std::thread> workers;
+        for (std::size_t i = 0; i < threads; ++i) {
+            workers.emplace_back([&, i] { sums[i] = CopyMany(ptr, kCopies / threads); });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    });
+    for (long sum : sums) {
+        checksum += sum;
+    }
+    return elapsed;
+}
+
+}  // namespace
+
+int main() {
+    std::size_t threads = std::max(4u, std::thread::hardware_concurrency());
+    long checksum = 0;
+
+    SharedPtr<Config> ordinary = MakeShared<Config>(1);
+    double ordinary_ms = Measure([&] { checksum += CopyMany(ordinary, kCopies); });
+
+    SharedPtr<Config> immortal = default_config.Share();
+    double immortal_ms = Measure([&] { checksum += CopyMany(immortal, kCopies); });
+    double contended_ms = CopyOnThreads(immortal, threads, checksum);
+
+    SharedPtr<Config> heap_immortal = MakeImmortal<Config>(1);
+    double heap_contended_ms = CopyOnThreads(heap_immortal, threads, checksum);
+
+    std::printf("%zu copies, best of %d rounds (checksum %ld)\n", kCopies, kRounds, checksum);
+    std::printf("%-36s %8.1f ms\n", "MakeShared, 1 thread", ordinary_ms);
+    std::printf("%-36s %8.1f ms\n", "StaticShared, 1 thread", immortal_ms);
+    std::printf("StaticShared, %-2zu threads %-12s %8.1f ms\n", threads, "", contended_ms);
+    std::printf("MakeImmortal, %-2zu threads %-12s %8.1f ms\n", threads, "", heap_contended_ms);
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "shared.h"
+
+#include <cstddef>  // std::nullptr_t
+#include <utility>
+
+template <typename T>
+class CowPtr;
+
+template <typename T, typename... Args>
+CowPtr<T> MakeCow(Args&&... args);
+
+// Copy-on-write pointer: copies share the value, mutable access clones it only if it is shared
+template <typename T>
+class CowPtr {
+public:
+    template <typename X, typename... Args>
+    friend CowPtr<X> MakeCow(Args&&... args);
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Constructors
+
+    CowPtr() = default;
+
+    CowPtr(std::nullptr_t) : CowPtr() {
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Modifiers
+
+    // Returns the value for writing, cloning it first if other `CowPtr`-s share it.
+    // Must not be called on an empty `CowPtr`.
+    T& Mutable() {
+        Detach();
+        return *ptr_;
+    }
+
+    void Reset() {
+        ptr_.Reset();
+    }
+
+    void Swap(CowPtr& other) {
+        ptr_.Swap(other.ptr_);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Observers
+
+    const T* Get() const {
+        return ptr_.Get();
+    }
+
+    const T& operator*() const {
+        return *ptr_;
+    }
+
+    const T* operator->() const {
+        return ptr_.Get();
+    }
+
+    size_t UseCount() const {
+        return ptr_.UseCount();
+    }
+
+    bool Unique() const {
+        return ptr_.UseCount() == 1;
+    }
+
+    explicit operator bool() const {
+        return static_cast<bool>(ptr_);
+    }
+
+private:
+    // Only MakeCow creates values, so no `SharedPtr` or `WeakPtr` to them exists outside
+    explicit CowPtr(SharedPtr<T> ptr) : ptr_(std::move(ptr)) {
+    }
+
+    void Detach() {
+        // The inner `SharedPtr` is never handed out, so the strong count alone tells whether
+        // we own the value exclusively
+        if (ptr_.UseCount() > 1) {
+            ptr_ = MakeShared<T>(std::as_const(*ptr_));
+        }
+    }
+
+private:
+    SharedPtr<T> ptr_;
+};
+
+template <typename T, typename U>
+inline bool operator==(const CowPtr<T>& left, const CowPtr<U>& right) noexcept {
+    return left.Get() == right.Get();
+}
+
+template <typename T, typename... Args>
+CowPtr<T> MakeCow(Args&&... args) {
+    return CowPtr<T>(MakeShared<T>(std::forward<Args>(args)...));
+}
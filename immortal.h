@@ -0,0 +1,39 @@
+#pragma once
+
+#include "shared.h"
+
+#include <utility>
+
+// Object with its own immortal controll block: copies of `SharedPtr`-s to it, and `WeakPtr`-s
+// locking it, skip every counter write. Both live in place, so a `StaticShared` with a constexpr
+// constructible `T` is constant-initialized and costs nothing at startup:
+//     static StaticShared<Config> kDefaultConfig;
+//     SharedPtr<Config> config = kDefaultConfig.Share();
+// It must outlive every pointer to it, which is why it belongs in static storage. Constant
+// initialization is checked at compile time in tests/immortal_test.cpp.
+template <typename T>
+class StaticShared {
+public:
+    template <typename... Args>
+    constexpr explicit StaticShared(Args&&... args)
+        : object_(std::forward<Args>(args)...), controll_(ImmortalTag{}) {
+    }
+
+    StaticShared(const StaticShared&) = delete;
+
+    StaticShared& operator=(const StaticShared&) = delete;
+
+    SharedPtr<T> Share() {
+        return SharedPtr<T>(&object_, &controll_);
+    }
+
+private:
+    T object_;
+    ControllBlock controll_;
+};
+
+// Heap-allocated immortal object, never freed
+template <typename T, typename... Args>
+SharedPtr<T> MakeImmortal(Args&&... args) {
+    return (new StaticShared<T>(std::forward<Args>(args)...))->Share();
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include "shared.h"
+#include "unique.h"
+#include "weak.h"
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Recycles storage of objects handed out as `SharedPtr`/`UniquePtr`.
+// Without a reset hook released objects are destructed and only their memory is reused,
+// with one they stay constructed: the hook is called on release and the object is handed
+// out again as is (constructor arguments are then used only on a miss).
+// Like the rest of the library the pool is not thread-safe: keep one per thread,
+// e.g. `thread_local ObjectPool<Message> pool(256)`. The pool must outlive its pointers.
+template <typename T>
+class ObjectPool {
+public:
+    struct PoolDeleter {
+        void operator()(T* ptr) const {
+            if (ptr) {
+                pool->Recycle(ptr);
+            }
+        }
+
+        ObjectPool* pool = nullptr;
+    };
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Constructors
+
+    explicit ObjectPool(size_t capacity, std::function<void(T&)> reset = nullptr)
+        : capacity_(capacity), reset_(std::move(reset)) {
+        free_.reserve(capacity_);
+    }
+
+    ObjectPool(const ObjectPool&) = delete;
+
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Destructor
+
+    ~ObjectPool() {
+        for (T* ptr : free_) {
+            if (reset_) {
+                ptr->~T();
+            }
+            Deallocate(ptr);
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Acquire
+
+    template <typename... Args>
+    SharedPtr<T> AcquireShared(Args&&... args) {
+        return SharedPtr<T>(Acquire(std::forward<Args>(args)...), PoolDeleter{this});
+    }
+
+    template <typename... Args>
+    UniquePtr<T, PoolDeleter> AcquireUnique(Args&&... args) {
+        return UniquePtr<T, PoolDeleter>(Acquire(std::forward<Args>(args)...), PoolDeleter{this});
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Observers
+
+    size_t Hits() const {
+        return hits_;
+    }
+
+    size_t Misses() const {
+        return misses_;
+    }
+
+    size_t Capacity() const {
+        return capacity_;
+    }
+
+    size_t Size() const {
+        return free_.size();
+    }
+
+private:
+    template <typename... Args>
+    T* Acquire(Args&&... args) {
+        if (free_.empty()) {
+            void* storage = Allocate();
+            T* ptr = nullptr;
+            try {
+                ptr = new (storage) T(std::forward<Args>(args)...);
+            } catch (...) {
+                Deallocate(storage);
+                throw;
+            }
+            ++misses_;
+            return ptr;
+        }
+
+        T* ptr = free_.back();
+        if (!reset_) {
+            // Popped only after construction, so the storage stays pooled if the constructor throws
+            new (static_cast<void*>(ptr)) T(std::forward<Args>(args)...);
+        }
+        free_.pop_back();
+        ++hits_;
+        return ptr;
+    }
+
+    void Recycle(T* ptr) {
+        if (reset_ && free_.size() < capacity_) {
+            if constexpr (std::is_base_of_v<EnableSharedFromThisBase, T>) {
+                // Unlink from the dead controll block, the next owner links the object again
+                auto stale = std::move(ptr->outer_shared_pointer_);
+            }
+            reset_(*ptr);
+            free_.push_back(ptr);
+            return;
+        }
+
+        ptr->~T();
+        if (free_.size() < capacity_) {
+            free_.push_back(ptr);
+        } else {
+            Deallocate(ptr);
+        }
+    }
+
+    static void* Allocate() {
+        return ::operator new(sizeof(T), std::align_val_t(alignof(T)));
+    }
+
+    static void Deallocate(void* storage) {
+        ::operator delete(storage, std::align_val_t(alignof(T)));
+    }
+
+private:
+    size_t capacity_;
+    std::function<void(T&)> reset_;
+    std::vector<T*> free_;
+    size_t hits_ = 0;
+    size_t misses_ = 0;
+};
@@ -3,6 +3,8 @@
 #include "sw_fwd.h"  // Forward declaration
 
 #include <cstddef>  // std::nullptr_t
+#include <type_traits>
+#include <utility>
 
 // https://en.cppreference.com/w/cpp/memory/shared_ptr
 template <typename T>
@@ -17,8 +19,25 @@ public:
     template <typename X>
     friend class EnableSharedFromThis;
 
+    template <typename X>
+    friend class SnapshotWriter;
+
+    template <typename X>
+    friend class StaticShared;
+
+    template <typename X>
+    friend class SharedSlab;
+
+    friend class SharedBatch;
+
     template <class X, class... Args>
     friend SharedPtr<X> MakeShared(Args&&... args);
+
+    template <class X, class... Args>
+    friend SharedPtr<X> MakeSharedSplit(Args&&... args);
+
+    template <class X, class... Args>
+    friend SharedPtr<X> MakeSharedIsolated(Args&&... args);
     ////////////////////////////////////////////////////////////////////////////////////////////////
     // Constructors
 
@@ -35,6 +54,14 @@ public:
         }
     }
 
+    template <class X, class Deleter>
+    SharedPtr(X* ptr, Deleter deleter)
+        : ptr_(static_cast<T*>(ptr)), controll_(MakeControllBlock(ptr, deleter)) {
+        if constexpr (std::is_base_of_v<EnableSharedFromThisBase, X>) {
+            SetLinkToOuterSharedPtr(ptr);
+        }
+    }
+
     SharedPtr(const SharedPtr& other) noexcept
         : ptr_(static_cast<T*>(other.ptr_)), controll_(other.controll_) {
         controll_->IncreaseStrong();
@@ -146,9 +173,8 @@ public:
     // Modifiers
 
     void Reset() {
-        if (controll_->DecreaseStrong()) {
-            delete controll_;
-        }
+        UnlinkWithControllBlock();
+
         controll_ = new ControllBlock(1, 0);
         ptr_ = nullptr;
     }
@@ -161,6 +187,15 @@ public:
         ptr_ = static_cast<T*>(ptr);
     }
 
+    template <class X, class Deleter>
+    void Reset(X* ptr, Deleter deleter) {
+        ControllBlock* block = MakeControllBlock(ptr, deleter);
+        UnlinkWithControllBlock();
+
+        controll_ = block;
+        ptr_ = static_cast<T*>(ptr);
+    }
+
     void Swap(SharedPtr& other) {
         std::swap(other.ptr_, ptr_);
         std::swap(controll_, other.controll_);
@@ -198,13 +233,20 @@ private:
         }
     }
 
+    // Like std::shared_ptr, disposes of `ptr` with `deleter` if the block can't be allocated
+    template <class X, class Deleter>
+    static ControllBlock* MakeControllBlock(X* ptr, Deleter& deleter) {
+        try {
+            return new ControllBlock(ptr, deleter);
+        } catch (...) {
+            deleter(ptr);
+            throw;
+        }
+    }
+
     void UnlinkWithControllBlock() {
         if (controll_ && controll_->DecreaseStrong()) {
-            if (controll_->created_from_make_shared) {
-                delete[](reinterpret_cast<char*>(controll_));
-            } else {
-                delete controll_;
-            }
+            DestroyControllBlock(controll_);
         }
     }
 
@@ -223,15 +265,65 @@ inline bool operator==(const SharedPtr<T>& left, const SharedPtr<U>& right) noex
     return left.Get() == right.Get();
 }
 
-// Allocate memory only once
+// Objects bigger than this are allocated apart from the controll block by MakeShared, so their
+// memory is returned as soon as the last `SharedPtr` dies, not when the last `WeakPtr` does
+inline constexpr std::size_t kMakeSharedInlineLimit = 1024;
+
+template <typename T>
+struct MakeSharedSplitsStorage : std::bool_constant<(sizeof(T) > kMakeSharedInlineLimit)> {};
+
+// Controll block in one allocation, object in another one
+template <typename T, typename... Args>
+SharedPtr<T> MakeSharedSplit(Args&&... args) {
+    char* space = static_cast<char*>(::operator new(sizeof(ControllBlock) + sizeof(AnyPtr<T>)));
+    T* object = nullptr;
+    try {
+        object = new T(std::forward<Args>(args)...);
+    } catch (...) {
+        ::operator delete(static_cast<void*>(space));
+        throw;
+    }
+    char* box_ptr = space + sizeof(ControllBlock);
+    new (reinterpret_cast<void*>(box_ptr)) AnyPtr<T>(object);
+    new (reinterpret_cast<void*>(space)) ControllBlock(reinterpret_cast<BaseAnyPtr*>(box_ptr));
+    reinterpret_cast<ControllBlock*>(space)->object_inlined = false;
+    return SharedPtr<T>(object, reinterpret_cast<ControllBlock*>(space));
+}
+
+// Allocate memory only once (twice for types with MakeSharedSplitsStorage)
 template <typename T, typename... Args>
 SharedPtr<T> MakeShared(Args&&... args) {  // no warranty here, ctors might throw -> memory leak
-    char* space = new char[sizeof(T) + sizeof(ControllBlock) + sizeof(AnyPtr<T>)];
+    if constexpr (MakeSharedSplitsStorage<T>::value) {
+        return MakeSharedSplit<T>(std::forward<Args>(args)...);
+    } else {
+        char* space = static_cast<char*>(
+            ::operator new(sizeof(T) + sizeof(ControllBlock) + sizeof(AnyPtr<T>)));
+        char* box_ptr = space + sizeof(ControllBlock);
+        char* type_ptr = box_ptr + sizeof(AnyPtr<T>);
+        new (reinterpret_cast<void*>(type_ptr)) T(std::forward<Args>(args)...);
+        new (reinterpret_cast<void*>(box_ptr)) AnyPtr<T>(reinterpret_cast<T*>(type_ptr));
+        new (reinterpret_cast<void*>(space)) ControllBlock(reinterpret_cast<BaseAnyPtr*>(box_ptr));
+        return SharedPtr<T>(reinterpret_cast<T*>(type_ptr),
+                            reinterpret_cast<ControllBlock*>(space));
+    }
+}
+
+// Like MakeShared, but counters and object get separate cache lines, so copying the pointer
+// doesn't bounce the line other threads write the object's fields to
+template <typename T, typename... Args>
+SharedPtr<T> MakeSharedIsolated(Args&&... args) {
+    static_assert(sizeof(ControllBlock) + sizeof(AnyPtr<T>) <= kCacheLineSize);
+    static_assert(alignof(T) <= kCacheLineSize);
+    constexpr std::size_t object_size =
+        (sizeof(T) + kCacheLineSize - 1) / kCacheLineSize * kCacheLineSize;
+    char* space = static_cast<char*>(
+        ::operator new(kCacheLineSize + object_size, std::align_val_t(kCacheLineSize)));
     char* box_ptr = space + sizeof(ControllBlock);
-    char* type_ptr = box_ptr + sizeof(AnyPtr<T>);
+    char* type_ptr = space + kCacheLineSize;
     new (reinterpret_cast<void*>(type_ptr)) T(std::forward<Args>(args)...);
     new (reinterpret_cast<void*>(box_ptr)) AnyPtr<T>(reinterpret_cast<T*>(type_ptr));
     new (reinterpret_cast<void*>(space)) ControllBlock(reinterpret_cast<BaseAnyPtr*>(box_ptr));
+    reinterpret_cast<ControllBlock*>(space)->cache_line_isolated = true;
     return SharedPtr<T>(reinterpret_cast<T*>(type_ptr), reinterpret_cast<ControllBlock*>(space));
 }
 
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "shared.h"
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+// Hands out `SharedPtr`-s whose controll blocks are packed next to each other in 4 KiB chunks,
+// while every object gets an allocation of its own. Counters of objects made by one slab share
+// cache lines with each other instead of with object fields: keep one slab per thread (or NUMA
+// node) that copies the pointers, e.g. `thread_local SharedSlab<Order> slab`.
+// Like the rest of the library it is not thread-safe. Pointers may outlive the slab, a chunk is
+// freed together with its last controll block.
+template <typename T>
+class SharedSlab {
+public:
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Constructors
+
+    SharedSlab() : chunk_(ControllBlockChunk::Create()) {
+    }
+
+    SharedSlab(const SharedSlab&) = delete;
+
+    SharedSlab& operator=(const SharedSlab&) = delete;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Destructor
+
+    ~SharedSlab() {
+        chunk_->Retire();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Make
+
+    template <typename... Args>
+    SharedPtr<T> Make(Args&&... args) {
+        static_assert(sizeof(AnyPtr<T>) == sizeof(AnyPtr<char>));
+        if (chunk_->Full()) {
+            ControllBlockChunk* next = ControllBlockChunk::Create();
+            chunk_->Retire();
+            chunk_ = next;
+        }
+        T* object = new T(std::forward<Args>(args)...);
+        char* space = chunk_->Take();
+        char* box_ptr = space + sizeof(ControllBlock);
+        new (reinterpret_cast<void*>(box_ptr)) AnyPtr<T>(object);
+        new (reinterpret_cast<void*>(space)) ControllBlock(reinterpret_cast<BaseAnyPtr*>(box_ptr));
+        reinterpret_cast<ControllBlock*>(space)->object_inlined = false;
+        reinterpret_cast<ControllBlock*>(space)->packed = true;
+        return SharedPtr<T>(object, reinterpret_cast<ControllBlock*>(space));
+    }
+
+private:
+    ControllBlockChunk* chunk_;
+};
@@ -0,0 +1,208 @@
+#pragma once
+
+#include "shared.h"
+#include "weak.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>  // std::memcpy
+#include <exception>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Binary snapshots of graphs of `T` held by `SharedPtr`/`WeakPtr`.
+// Every node (controll block) is written once, edges are stored as node indices, so shared
+// nodes stay shared and weak edges survive the round trip. `T` has to be default
+// constructible and provide
+//     void Save(SnapshotWriter<T>& writer) const;
+//     void Load(SnapshotReader<T>& reader);
+// which write and read the same fields in the same order.
+//
+// Layout: magic, node count, root count, root indices, then node records in index order,
+// each prefixed with its size. Integers are stored in host byte order.
+
+class BadSnapshot : public std::exception {};
+
+inline constexpr char kSnapshotMagic[8] = "SPSNAP2";
+inline constexpr std::uint64_t kSnapshotNullIndex = ~std::uint64_t{0};
+
+template <typename T>
+class SnapshotWriter {
+public:
+    void AddRoot(const SharedPtr<T>& root) {
+        roots_.push_back(IndexOf(root));
+    }
+
+    void WriteBytes(const void* data, std::size_t size) {
+        const char* bytes = static_cast<const char*>(data);
+        body_.insert(body_.end(), bytes, bytes + size);
+    }
+
+    template <class P>
+    void Write(const P& value) {
+        static_assert(std::is_trivially_copyable_v<P>);
+        WriteBytes(&value, sizeof(P));
+    }
+
+    void WriteStrong(const SharedPtr<T>& edge) {
+        Write(IndexOf(edge));
+    }
+
+    // Weak edges to nodes that are not strongly reachable from the roots are written as empty
+    void WriteWeak(const WeakPtr<T>& edge) {
+        if (edge.controll_ && !edge.Expired()) {
+            weak_edges_.emplace_back(body_.size(), edge);
+        }
+        Write(kSnapshotNullIndex);
+    }
+
+    std::vector<char> Finish() {
+        for (std::size_t i = 0; i < nodes_.size(); ++i) {  // Save() may append new nodes
+            std::size_t start = body_.size();
+            Write(std::uint64_t{0});
+            nodes_[i]->Save(*this);
+            std::uint64_t record_size = body_.size() - start - sizeof(std::uint64_t);
+            std::memcpy(body_.data() + start, &record_size, sizeof(record_size));
+        }
+
+        for (const auto& [offset, edge] : weak_edges_) {
+            auto it = index_.find(edge.controll_);
+            if (it != index_.end()) {
+                std::memcpy(body_.data() + offset, &it->second, sizeof(std::uint64_t));
+            }
+        }
+
+        std::vector<char> header;
+        std::swap(header, body_);
+        WriteBytes(kSnapshotMagic, sizeof(kSnapshotMagic));
+        Write(static_cast<std::uint64_t>(nodes_.size()));
+        Write(static_cast<std::uint64_t>(roots_.size()));
+        WriteBytes(roots_.data(), roots_.size() * sizeof(std::uint64_t));
+        std::swap(header, body_);
+
+        header.insert(header.end(), body_.begin(), body_.end());
+        *this = SnapshotWriter();
+        return header;
+    }
+
+private:
+    std::uint64_t IndexOf(const SharedPtr<T>& ptr) {
+        if (!ptr.ptr_) {
+            return kSnapshotNullIndex;
+        }
+        auto [it, inserted] = index_.emplace(ptr.controll_, nodes_.size());
+        if (inserted) {
+            nodes_.push_back(ptr);
+        }
+        return it->second;
+    }
+
+private:
+    // Nodes and weak edge targets are held until Finish(), so no block address can be reused
+    std::unordered_map<const ControllBlock*, std::uint64_t> index_;
+    std::vector<SharedPtr<T>> nodes_;
+    std::vector<std::uint64_t> roots_;
+    std::vector<std::pair<std::size_t, WeakPtr<T>>> weak_edges_;
+    std::vector<char> body_;
+};
+
+// Reads straight from `data`, which may as well be an mmap-ed snapshot file.
+// All nodes are allocated up front, one MakeShared block each, before any of them is loaded.
+template <typename T>
+class SnapshotReader {
+public:
+    SnapshotReader(const char* data, std::size_t size) : data_(data), size_(size), end_(size) {
+    }
+
+    // Returns the roots in the order they were added to the writer
+    std::vector<SharedPtr<T>> Load() {
+        char magic[sizeof(kSnapshotMagic)];
+        ReadBytes(magic, sizeof(magic));
+        if (std::memcmp(magic, kSnapshotMagic, sizeof(magic)) != 0) {
+            throw BadSnapshot();
+        }
+        auto node_count = Read<std::uint64_t>();
+        auto root_count = Read<std::uint64_t>();
+        if (root_count > (size_ - pos_) / sizeof(std::uint64_t)) {
+            throw BadSnapshot();
+        }
+        std::vector<std::uint64_t> roots(root_count);
+        ReadBytes(roots.data(), root_count * sizeof(std::uint64_t));
+        // Every record starts with its size, so the count can't exceed what the input holds
+        if (node_count > (size_ - pos_) / sizeof(std::uint64_t)) {
+            throw BadSnapshot();
+        }
+
+        nodes_.reserve(node_count);
+        for (std::uint64_t i = 0; i < node_count; ++i) {
+            nodes_.push_back(MakeShared<T>());
+        }
+        for (std::uint64_t i = 0; i < node_count; ++i) {
+            auto record_size = Read<std::uint64_t>();
+            if (record_size > size_ - pos_) {
+                throw BadSnapshot();
+            }
+            end_ = pos_ + record_size;
+            nodes_[i]->Load(*this);
+            if (pos_ != end_) {
+                throw BadSnapshot();
+            }
+            end_ = size_;
+        }
+        if (pos_ != size_) {
+            throw BadSnapshot();
+        }
+
+        std::vector<SharedPtr<T>> result;
+        result.reserve(root_count);
+        for (std::uint64_t index : roots) {
+            result.push_back(Node(index));
+        }
+        nodes_.clear();
+        return result;
+    }
+
+    void ReadBytes(void* out, std::size_t size) {
+        if (size > end_ - pos_) {
+            throw BadSnapshot();
+        }
+        std::memcpy(out, data_ + pos_, size);
+        pos_ += size;
+    }
+
+    template <class P>
+    P Read() {
+        static_assert(std::is_trivially_copyable_v<P>);
+        P value;
+        ReadBytes(&value, sizeof(P));
+        return value;
+    }
+
+    SharedPtr<T> ReadStrong() {
+        return Node(Read<std::uint64_t>());
+    }
+
+    WeakPtr<T> ReadWeak() {
+        return WeakPtr<T>(Node(Read<std::uint64_t>()));
+    }
+
+private:
+    SharedPtr<T> Node(std::uint64_t index) const {
+        if (index == kSnapshotNullIndex) {
+            return SharedPtr<T>();
+        }
+        if (index >= nodes_.size()) {
+            throw BadSnapshot();
+        }
+        return nodes_[index];
+    }
+
+private:
+    const char* data_;
+    std::size_t size_;
+    std::size_t end_;  // end of the record being loaded
+    std::size_t pos_ = 0;
+    std::vector<SharedPtr<T>> nodes_;
+};
@@ -1,6 +1,11 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>  // std::uintptr_t
+#include <cstring>  // std::memcpy
 #include <exception>
+#include <new>
+#include <utility>
 
 class BadWeakPtr : public std::exception {};
 
@@ -15,6 +20,19 @@ class EnableSharedFromThis;
 
 class EnableSharedFromThisBase;
 
+class SharedBatch;
+
+template <typename T>
+class StaticShared;
+
+struct ImmortalTag {};
+
+template <typename T>
+class SharedSlab;
+
+template <typename T>
+class SnapshotWriter;
+
 struct BaseAnyPtr {
     virtual void Delete() = 0;
     virtual void Destruct() = 0;
@@ -46,11 +64,46 @@ struct AnyPtr final : public BaseAnyPtr {
     T* ptr;
 };
 
+template <class T, class Deleter>
+struct DeleterAnyPtr final : public BaseAnyPtr {
+
+    template <class X>
+    DeleterAnyPtr(X* pointer, Deleter del)
+        : ptr(static_cast<T*>(pointer)), deleter(std::move(del)) {
+    }
+
+    void Delete() override {
+        deleter(ptr);
+    }
+
+    void Destruct() override {
+        ptr->~T();
+    }
+
+    void Release() override {
+        ptr = nullptr;
+    }
+
+    ~DeleterAnyPtr() override = default;
+
+    T* ptr;
+    Deleter deleter;
+};
+
+inline constexpr std::size_t kCacheLineSize = 64;
+
 struct ControllBlock {
     std::size_t strong = 0;
     std::size_t weak = 0;
     BaseAnyPtr* ptr = nullptr;
     bool created_from_make_shared = false;
+    bool object_inlined = true;        // object lives in the same allocation as the controll block
+    bool immortal = false;             // counters are never touched, nothing is ever freed
+    bool cache_line_isolated = false;  // allocated with kCacheLineSize alignment
+    bool packed = false;               // lives in a ControllBlockChunk of a SharedSlab
+
+    // Strong count reported by immortal blocks, big enough for any uniqueness check to fail
+    static constexpr std::size_t kImmortalStrong = ~std::size_t{0} >> 1;
 
     ControllBlock(std::size_t st, std::size_t we) noexcept : strong(st), weak(we) {
     }
@@ -60,19 +113,37 @@ struct ControllBlock {
         : strong(1), weak(0), ptr(new AnyPtr<X>(ptr)) {  // this ctor is only for SharedPtr
     }
 
+    template <class X, class Deleter>
+    ControllBlock(X* ptr, Deleter deleter)
+        : strong(1),
+          weak(0),
+          ptr(new DeleterAnyPtr<X, Deleter>(ptr, std::move(deleter))) {  // SharedPtr with deleter
+    }
+
     ControllBlock(BaseAnyPtr* pointer) noexcept
         : ptr(pointer),
           created_from_make_shared(true) {  // this ctor is for SharedPtr created via MakeShared
     }
 
+    constexpr ControllBlock(ImmortalTag) noexcept
+        : strong(kImmortalStrong), immortal(true) {  // this ctor is for StaticShared
+    }
+
     bool DecreaseStrong() {
         /* Return true if we can destruct controll block, otherwise - false */
+        if (immortal) {
+            return false;
+        }
         if (strong == 1) {
             if (ptr && !created_from_make_shared) {
                 ptr->Delete();
                 delete ptr;
             } else if (ptr && created_from_make_shared) {
-                ptr->Destruct();
+                if (object_inlined) {
+                    ptr->Destruct();
+                } else {
+                    ptr->Delete();
+                }
                 ptr->~BaseAnyPtr();
             }
         }
@@ -80,19 +151,122 @@ struct ControllBlock {
         return (strong == 0 && weak == 0);
     }
 
+    bool DecreaseStrong(std::size_t count) {
+        /* Drops `count` strong references at once, see DecreaseStrong() */
+        if (immortal) {
+            return false;
+        }
+        strong -= count - 1;
+        return DecreaseStrong();
+    }
+
     void IncreaseStrong() {
-        ++strong;
+        if (!immortal) {
+            ++strong;
+        }
+    }
+
+    void IncreaseStrong(std::size_t count) {
+        if (!immortal) {
+            strong += count;
+        }
     }
 
     void IncreaseWeak() {
-        ++weak;
+        if (!immortal) {
+            ++weak;
+        }
     }
 
     bool DecreaseWeak() {
         /* Returns true if we can destruct controll block, otherwise - false */
+        if (immortal) {
+            return false;
+        }
         --weak;
         return (strong == 0 && weak == 0);
     }
 
     ~ControllBlock() = default;
 };
+
+// Controll blocks of one SharedSlab packed next to each other, each one followed by its `AnyPtr`
+// box. Chunks are aligned to their size, so a block finds its chunk by masking its address.
+// Freed slots are reused, the chunk itself is freed once it's retired by the slab and its last
+// slot is freed.
+struct ControllBlockChunk {
+    static constexpr std::size_t kSize = 4096;
+    static constexpr std::size_t kSlotSize = sizeof(ControllBlock) + sizeof(AnyPtr<char>);
+
+    static ControllBlockChunk* Create() {
+        return new (::operator new(kSize, std::align_val_t(kSize))) ControllBlockChunk();
+    }
+
+    static ControllBlockChunk* Of(ControllBlock* block) {
+        return reinterpret_cast<ControllBlockChunk*>(reinterpret_cast<std::uintptr_t>(block) &
+                                                     ~std::uintptr_t{kSize - 1});
+    }
+
+    static constexpr std::size_t Capacity();
+
+    bool Full() const {
+        return !free && used == Capacity();
+    }
+
+    // Returns an uninitialized slot, the chunk must not be full
+    char* Take() {
+        char* slot;
+        if (free) {
+            slot = free;
+            std::memcpy(&free, slot, sizeof(free));
+        } else {
+            slot = reinterpret_cast<char*>(this + 1) + used++ * kSlotSize;
+        }
+        ++live;
+        return slot;
+    }
+
+    void Release(ControllBlock* block) {
+        char* slot = reinterpret_cast<char*>(block);
+        std::memcpy(slot, &free, sizeof(free));
+        free = slot;
+        --live;
+        FreeIfUnused();
+    }
+
+    // Called once by the slab when it stops taking slots from this chunk
+    void Retire() {
+        retired = true;
+        FreeIfUnused();
+    }
+
+private:
+    void FreeIfUnused() {
+        if (retired && live == 0) {
+            ::operator delete(static_cast<void*>(this), std::align_val_t(kSize));
+        }
+    }
+
+public:
+    std::size_t used = 0;  // slots ever taken, the rest are past the end
+    std::size_t live = 0;
+    char* free = nullptr;  // freed slots, each one starts with the next one
+    bool retired = false;
+};
+
+constexpr std::size_t ControllBlockChunk::Capacity() {
+    return (kSize - sizeof(ControllBlockChunk)) / kSlotSize;
+}
+
+// Every kind of controll block is freed the way it was allocated
+inline void DestroyControllBlock(ControllBlock* block) {
+    if (block->cache_line_isolated) {  // MakeSharedIsolated
+        ::operator delete(static_cast<void*>(block), std::align_val_t(kCacheLineSize));
+    } else if (block->packed) {  // SharedSlab
+        ControllBlockChunk::Of(block)->Release(block);
+    } else if (block->created_from_make_shared) {  // MakeShared, MakeSharedSplit
+        ::operator delete(static_cast<void*>(block));
+    } else {  // SharedPtr(ptr), SharedPtr(ptr, deleter)
+        delete block;
+    }
+}
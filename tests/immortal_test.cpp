@@ -0,0 +1,61 @@
+// Immortal objects: constant initialization of StaticShared and counters that never change
+#include "immortal.h"
+#include "weak.h"
+
+#include <cstdio>
+#include <type_traits>
+
+namespace {
+
+int failures = 0;
+
+void Check(bool condition, const char* what) {
+    if (!condition) {
+        std::printf("FAILED: %s\n", what);
+        ++failures;
+    }
+}
+
+struct Config {
+    constexpr explicit Config(int value = 0) : value(value) {
+    }
+
+    int value;
+};
+
+// Compiles only if StaticShared is constant-initialized: no startup cost
+constexpr StaticShared<Config> kConstantConfig(5);
+static_assert(std::is_trivially_destructible_v<StaticShared<Config>>);
+
+StaticShared<Config> default_config(7);
+
+void TestCountersAreUntouched() {
+    SharedPtr<Config> config = default_config.Share();
+    std::size_t use_count = config.UseCount();
+    Check(use_count == ControllBlock::kImmortalStrong, "immortal use count");
+    {
+        SharedPtr<Config> copy = config;
+        SharedPtr<Config> another = default_config.Share();
+        WeakPtr<Config> weak = config;
+        SharedPtr<Config> locked = weak.Lock();
+        Check(locked->value == 7, "WeakPtr locks an immortal object");
+        Check(config.UseCount() == use_count, "copies don't touch the counter");
+    }
+    config.Reset();
+    Check(default_config.Share()->value == 7, "object outlives every pointer");
+}
+
+void TestMakeImmortal() {
+    SharedPtr<Config> config = MakeImmortal<Config>(9);
+    WeakPtr<Config> weak = config;
+    config.Reset();
+    Check(!weak.Expired() && weak.Lock()->value == 9, "MakeImmortal object never dies");
+}
+
+}  // namespace
+
+int main() {
+    TestCountersAreUntouched();
+    TestMakeImmortal();
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,75 @@
+// MakeShared of a large object must give its memory back when the last SharedPtr dies,
+// even though a WeakPtr still keeps the controll block alive
+#include "shared.h"
+#include "weak.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include <unistd.h>  // sysconf
+
+namespace {
+
+constexpr int kSkipped = 77;
+constexpr std::size_t kObjectSize = 64 << 20;
+constexpr long kMinDifference = (kObjectSize * 3 / 4) >> 10;
+
+struct Big {
+    Big() {
+        std::memset(data, 1, sizeof(data));  // make every page resident
+    }
+
+    char data[kObjectSize];
+};
+
+struct Small {
+    int value = 0;
+};
+
+static_assert(MakeSharedSplitsStorage<Big>::value);
+static_assert(!MakeSharedSplitsStorage<Small>::value);
+
+// Resident set size in KiB, -1 if unknown
+long ResidentKiB() {
+    std::ifstream statm("/proc/self/statm");
+    long size = 0;
+    long resident = 0;
+    if (!(statm >> size >> resident)) {
+        return -1;
+    }
+    return resident * (sysconf(_SC_PAGESIZE) >> 10);
+}
+
+}  // namespace
+
+int main() {
+    long before = ResidentKiB();
+    if (before < 0) {
+        std::puts("SKIPPED: /proc/self/statm is not available");
+        return kSkipped;
+    }
+
+    SharedPtr<Big> strong = MakeShared<Big>();
+    WeakPtr<Big> weak = strong;
+    long alive = ResidentKiB();
+    strong.Reset();
+    long released = ResidentKiB();
+
+    std::printf("RSS KiB: before %ld, alive %ld, after last SharedPtr %ld\n", before, alive,
+                released);
+    if (alive - before < kMinDifference) {
+        std::puts("FAILED: object did not become resident");
+        return 1;
+    }
+    if (alive - released < kMinDifference) {
+        std::puts("FAILED: object memory is still resident while only a WeakPtr remains");
+        return 1;
+    }
+    if (!weak.Expired()) {
+        std::puts("FAILED: WeakPtr is not expired");
+        return 1;
+    }
+    return 0;
+}
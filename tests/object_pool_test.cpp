@@ -0,0 +1,119 @@
+// ObjectPool: hit/miss accounting, over-aligned types, throwing constructors and
+// EnableSharedFromThis objects reused through the reset hook
+#include "pool.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+
+namespace {
+
+int failures = 0;
+
+void Check(bool condition, const char* what) {
+    if (!condition) {
+        std::printf("FAILED: %s\n", what);
+        ++failures;
+    }
+}
+
+struct Message {
+    explicit Message(int id = 0) : id(id) {
+    }
+
+    int id;
+};
+
+struct Node : EnableSharedFromThis<Node> {
+    int generation = 0;
+};
+
+struct alignas(64) Aligned {
+    char payload[10];
+};
+
+struct Throwing {
+    explicit Throwing(bool fail) {
+        if (fail) {
+            throw std::runtime_error("constructor failed");
+        }
+    }
+};
+
+bool IsAligned(const void* ptr, std::size_t alignment) {
+    return reinterpret_cast<std::uintptr_t>(ptr) % alignment == 0;
+}
+
+void TestHitsAndMisses() {
+    ObjectPool<Message> pool(2);
+    {
+        auto first = pool.AcquireShared(1);
+        auto second = pool.AcquireUnique(2);
+        auto third = pool.AcquireShared(3);
+        Check(first->id == 1 && second->id == 2 && third->id == 3, "constructor arguments");
+    }
+    Check(pool.Misses() == 3 && pool.Hits() == 0, "three misses on an empty pool");
+    Check(pool.Size() == 2, "free list is bounded by the capacity");
+
+    auto reused = pool.AcquireShared(7);
+    auto unique = pool.AcquireUnique(8);
+    Check(reused->id == 7 && unique->id == 8, "reused storage is constructed again");
+    Check(pool.Hits() == 2 && pool.Misses() == 3, "two hits from the free list");
+    Check(pool.Size() == 0, "free list is drained");
+}
+
+void TestThrowingConstructor() {
+    ObjectPool<Throwing> pool(2);
+    try {
+        pool.AcquireShared(true);
+        Check(false, "miss rethrows");
+    } catch (const std::runtime_error&) {
+    }
+    Check(pool.Misses() == 0, "failed construction is not a miss");
+
+    { auto ok = pool.AcquireShared(false); }
+    try {
+        pool.AcquireUnique(true);
+        Check(false, "hit rethrows");
+    } catch (const std::runtime_error&) {
+    }
+    Check(pool.Hits() == 0, "failed construction is not a hit");
+    Check(pool.Size() == 1, "storage stays pooled after a throwing constructor");
+}
+
+void TestAlignment() {
+    ObjectPool<Aligned> pool(4);
+    for (int i = 0; i < 3; ++i) {
+        auto shared = pool.AcquireShared();
+        auto unique = pool.AcquireUnique();
+        Check(IsAligned(shared.Get(), alignof(Aligned)), "shared object is aligned");
+        Check(IsAligned(unique.Get(), alignof(Aligned)), "unique object is aligned");
+    }
+}
+
+void TestSharedFromThisRoundTrips() {
+    ObjectPool<Node> pool(4, [](Node& node) { ++node.generation; });
+    for (int i = 0; i < 3; ++i) {
+        auto node = pool.AcquireShared();
+        Check(node->generation == i, "reset hook runs between round trips");
+        try {
+            Check(node->SharedFromThis().Get() == node.Get(), "SharedFromThis after reuse");
+            Check(node.UseCount() == 1, "SharedFromThis temporary is released");
+        } catch (const BadWeakPtr&) {
+            Check(false, "SharedFromThis throws on a reused object");
+        }
+        WeakPtr<Node> weak = node->WeakFromThis();
+        Check(weak.Lock().Get() == node.Get(), "WeakFromThis after reuse");
+    }
+    Check(pool.Hits() == 2 && pool.Misses() == 1, "one object serves every round trip");
+}
+
+}  // namespace
+
+int main() {
+    TestHitsAndMisses();
+    TestThrowingConstructor();
+    TestAlignment();
+    TestSharedFromThisRoundTrips();
+    return failures == 0 ? 0 : 1;
+}
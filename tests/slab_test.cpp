@@ -0,0 +1,92 @@
+// SharedSlab: packed controll blocks, slot reuse, pointers outliving the slab
+#include "slab.h"
+#include "weak.h"
+
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+void Check(bool condition, const char* what) {
+    if (!condition) {
+        std::printf("FAILED: %s\n", what);
+        ++failures;
+    }
+}
+
+int alive = 0;
+
+struct Node {
+    explicit Node(int value = 0) : value(value) {
+        ++alive;
+    }
+
+    ~Node() {
+        --alive;
+    }
+
+    int value;
+};
+
+struct Self : EnableSharedFromThis<Self> {};
+
+void TestBlocksArePacked() {
+    SharedSlab<Node> slab;
+    SharedPtr<Node> first = slab.Make(1);
+    SharedPtr<Node> second = slab.Make(2);
+    Check(first->value == 1 && second->value == 2, "objects are constructed");
+    SharedPtr<Node> copy = first;
+    Check(first.UseCount() == 2 && second.UseCount() == 1, "counters are separate");
+}
+
+void TestSlotsAreReused() {
+    SharedSlab<Node> slab;
+    {
+        SharedPtr<Node> a = slab.Make();
+        SharedPtr<Node> b = slab.Make();
+    }
+    Check(alive == 0, "objects die with their last SharedPtr");
+    constexpr int kCount = 3 * ControllBlockChunk::Capacity() + 1;  // spills over into new chunks
+    std::vector<SharedPtr<Node>> nodes;
+    for (int i = 0; i < kCount; ++i) {
+        nodes.push_back(slab.Make(i));
+    }
+    Check(alive == kCount && nodes[kCount - 1]->value == kCount - 1, "slab grows by chunks");
+    nodes.clear();
+    Check(alive == 0, "every object is destroyed");
+}
+
+void TestPointersOutliveSlab() {
+    SharedPtr<Node> survivor;
+    WeakPtr<Node> weak;
+    {
+        SharedSlab<Node> slab;
+        survivor = slab.Make(7);
+        SharedPtr<Node> dead = slab.Make(8);
+        weak = dead;
+    }
+    Check(weak.Expired(), "weak pointer expires");
+    Check(survivor->value == 7, "object outlives its slab");
+    survivor.Reset();
+    Check(alive == 0, "last pointer frees the object");
+    weak = WeakPtr<Node>();  // frees the last slot and the chunk
+}
+
+void TestSharedFromThis() {
+    SharedSlab<Self> slab;
+    SharedPtr<Self> self = slab.Make();
+    SharedPtr<Self> again = self->SharedFromThis();
+    Check(self.UseCount() == 2, "SharedFromThis shares the packed block");
+}
+
+}  // namespace
+
+int main() {
+    TestBlocksArePacked();
+    TestSlotsAreReused();
+    TestPointersOutliveSlab();
+    TestSharedFromThis();
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,119 @@
+// Snapshot round trip of a graph with a shared node and weak back-edges,
+// plus every truncated prefix of the snapshot failing with BadSnapshot
+#include "snapshot.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+void Check(bool condition, const char* what) {
+    if (!condition) {
+        std::printf("FAILED: %s\n", what);
+        ++failures;
+    }
+}
+
+struct Node {
+    void Save(SnapshotWriter<Node>& writer) const {
+        writer.Write(value);
+        writer.Write(static_cast<std::uint64_t>(children.size()));
+        for (const auto& child : children) {
+            writer.WriteStrong(child);
+        }
+        writer.WriteWeak(parent);
+    }
+
+    void Load(SnapshotReader<Node>& reader) {
+        value = reader.Read<int>();
+        children.resize(reader.Read<std::uint64_t>());
+        for (auto& child : children) {
+            child = reader.ReadStrong();
+        }
+        parent = reader.ReadWeak();
+    }
+
+    int value = 0;
+    std::vector<SharedPtr<Node>> children;
+    WeakPtr<Node> parent;
+};
+
+SharedPtr<Node> MakeNode(int value) {
+    auto node = MakeShared<Node>();
+    node->value = value;
+    return node;
+}
+
+// root(1) -> left(2), right(3); left and right -> shared(4); weak edges go back up,
+// except for right(3), whose weak edge points to a node outside of the snapshot
+std::vector<char> WriteGraph() {
+    auto root = MakeNode(1);
+    auto left = MakeNode(2);
+    auto right = MakeNode(3);
+    auto shared = MakeNode(4);
+    auto outside = MakeNode(5);
+    left->children.push_back(shared);
+    right->children.push_back(shared);
+    right->children.push_back(SharedPtr<Node>());
+    root->children = {left, right};
+    left->parent = root;
+    right->parent = outside;
+    shared->parent = left;
+
+    SnapshotWriter<Node> writer;
+    writer.AddRoot(root);
+    writer.AddRoot(shared);
+    return writer.Finish();
+}
+
+void TestRoundTrip(const std::vector<char>& snapshot) {
+    auto roots = SnapshotReader<Node>(snapshot.data(), snapshot.size()).Load();
+    Check(roots.size() == 2, "both roots are loaded");
+    if (roots.size() != 2) {
+        return;
+    }
+    const auto& root = roots[0];
+    Check(root->value == 1 && root->children.size() == 2, "root is loaded");
+    const auto& left = root->children[0];
+    const auto& right = root->children[1];
+    Check(left->value == 2 && right->value == 3, "children are loaded");
+    Check(left->children[0].Get() == right->children[0].Get(), "shared node stays shared");
+    Check(roots[1].Get() == left->children[0].Get(), "second root is the shared node");
+    Check(roots[1].UseCount() == 3, "shared node is owned by both parents and the root list");
+    Check(!right->children[1], "empty edge stays empty");
+    Check(left->parent.Lock().Get() == root.Get(), "weak back-edge to the root");
+    Check(roots[1]->parent.Lock().Get() == left.Get(), "weak back-edge to a child");
+    Check(right->parent.Expired(), "weak edge out of the snapshot is empty");
+}
+
+void TestTemporaryRoot() {
+    SnapshotWriter<Node> writer;
+    writer.AddRoot(MakeNode(7));
+    auto snapshot = writer.Finish();
+    auto roots = SnapshotReader<Node>(snapshot.data(), snapshot.size()).Load();
+    Check(roots.size() == 1 && roots[0]->value == 7, "writer keeps temporary roots alive");
+}
+
+void TestTruncated(const std::vector<char>& snapshot) {
+    for (std::size_t size = 0; size < snapshot.size(); ++size) {
+        try {
+            SnapshotReader<Node>(snapshot.data(), size).Load();
+            std::printf("FAILED: prefix of %zu bytes is accepted\n", size);
+            ++failures;
+        } catch (const BadSnapshot&) {
+        }
+    }
+}
+
+}  // namespace
+
+int main() {
+    auto snapshot = WriteGraph();
+    TestRoundTrip(snapshot);
+    TestTemporaryRoot();
+    TestTruncated(snapshot);
+    return failures == 0 ? 0 : 1;
+}
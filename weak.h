@@ -14,6 +14,9 @@ public:
 
     template <typename X>
     friend class EnableSharedFromThis;
+
+    template <typename X>
+    friend class SnapshotWriter;
     ////////////////////////////////////////////////////////////////////////////////////////////////
     // Constructors
 
@@ -151,11 +154,7 @@ public:
 private:
     void UnlinkWithControllBlock() {
         if (controll_ && controll_->DecreaseWeak()) {
-            if (controll_->created_from_make_shared) {
-                delete[](reinterpret_cast<char*>(controll_));
-            } else {
-                delete controll_;
-            }
+            DestroyControllBlock(controll_);
         }
     }
 